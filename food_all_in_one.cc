@@ -0,0 +1,108 @@
+#include "include/food_all_in_one.h"
+
+
+// Build a server with no listening ports, reachable only through InProcessChannel()
+std::unique_ptr<Server> StartInProcessServer(grpc::Service* service) {
+    ServerBuilder builder;
+    builder.RegisterService(service);
+    return builder.BuildAndStart();
+}
+
+
+void RunFoodAllInOne(InternalTransport transport, const ViewOptions& view_options) {
+    RegisterTelemetry();
+
+    LoadVendorMap();
+    LoadInventories();
+
+    FoodSupplierService supplier_service;
+    FoodVendorService vendor_service;
+
+    std::unique_ptr<Server> supplier_server;
+    std::unique_ptr<Server> vendor_server;
+    std::unique_ptr<FoodFinder> supplier_finder;
+    std::unique_ptr<FoodFinder> vendor_finder;
+
+    if (transport == InternalTransport::kInProcess) {
+        supplier_server = StartInProcessServer(&supplier_service);
+        vendor_server = StartInProcessServer(&vendor_service);
+
+        supplier_finder.reset(new FoodFinder(
+                supplier_server->InProcessChannel(grpc::ChannelArguments())));
+        vendor_finder.reset(new FoodFinder(
+                vendor_server->InProcessChannel(grpc::ChannelArguments())));
+        std::cout << "Internal calls use in-process channels" << std::endl;
+    }
+    else {
+        supplier_finder.reset(new FoodFinder(&supplier_service));
+        vendor_finder.reset(new FoodFinder(&vendor_service));
+        std::cout << "Internal calls use direct C++ calls" << std::endl;
+    }
+
+    FoodFinderService finder_service(std::move(supplier_finder), std::move(vendor_finder));
+
+    if (view_options.enabled) {
+        finder_service.EnableView(view_options);
+    }
+
+    ServeFoodFinder(&finder_service);
+
+    delete kVendorMap;
+    delete kInventories;
+    delete kPrices;
+}
+
+
+bool ParseFlags(int argc, char** argv, InternalTransport* transport, ViewOptions* view_options) {
+    const std::string transport_flag = "--internal_transport=";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        ViewFlagResult view_flag_result = ParseViewFlag(arg, view_options);
+        if (view_flag_result == ViewFlagResult::kInvalid) {
+            return false;
+        }
+        if (view_flag_result == ViewFlagResult::kParsed) {
+            continue;
+        }
+
+        if (arg == "--no_random_faults") {
+            SetRandomFaultsEnabled(false);
+            continue;
+        }
+
+        if (arg.rfind(transport_flag, 0) != 0) {
+            std::cerr << "Unknown flag: " << arg << std::endl;
+            return false;
+        }
+
+        const std::string value = arg.substr(transport_flag.size());
+        if (value == "inprocess") {
+            *transport = InternalTransport::kInProcess;
+        }
+        else if (value == "direct") {
+            *transport = InternalTransport::kDirect;
+        }
+        else {
+            std::cerr << "Unknown internal transport: " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    InternalTransport transport = InternalTransport::kInProcess;
+    ViewOptions view_options;
+    if (!ParseFlags(argc, argv, &transport, &view_options)) {
+        std::cerr << "Usage: " << argv[0] << " [--internal_transport=inprocess|direct] [--no_random_faults] "
+                  << kViewFlagsUsage << std::endl;
+        return 1;
+    }
+
+    RunFoodAllInOne(transport, view_options);
+
+    return 0;
+}
@@ -26,6 +26,27 @@ std::tuple<bool, std::vector<std::string>> FoodClient::GetVendorsInfo(const std:
 }
 
 
+// Async call to FoodFinder
+void FoodClient::AsyncGetVendorsInfo(const std::string& ingredient, size_t index,
+                                     int timeout_ms, CompletionQueue* cq) {
+    FinderRequest request;
+    request.set_ingredient(ingredient);
+
+    AsyncFinderCall* call = new AsyncFinderCall;
+    call->index = index;
+    call->ingredient = ingredient;
+    call->start = std::chrono::steady_clock::now();
+
+    // A hung lookup would otherwise hold back all ordered output after it
+    call->context.set_deadline(std::chrono::system_clock::now() +
+        std::chrono::milliseconds(timeout_ms));
+
+    call->response_reader = stub_->PrepareAsyncGetVendorsInfo(&call->context, request, cq);
+    call->response_reader->StartCall();
+    call->response_reader->Finish(&call->reply, &call->status, static_cast<void*>(call));
+}
+
+
 std::string GetUserInput() {
     std::cout << std::endl << kUserInputPrompt;
 
@@ -44,16 +65,287 @@ void PrintResults(std::vector<std::string> vendors_with_info) {
 }
 
 
+// Read the next non-empty line from input, trimmed of surrounding whitespace.
+// Return false once input is exhausted.
+bool ReadIngredient(std::istream& input, std::string* ingredient) {
+    const std::string whitespace = " \t\r\n";
+    std::string line;
+
+    while (std::getline(input, line)) {
+        size_t first = line.find_first_not_of(whitespace);
+        if (first == std::string::npos) {
+            continue;
+        }
+        size_t last = line.find_last_not_of(whitespace);
+        *ingredient = line.substr(first, last - first + 1);
+        return true;
+    }
+    return false;
+}
+
+
+BatchResult ToBatchResult(const AsyncFinderCall& call, bool ok) {
+    BatchResult result;
+    result.index = call.index;
+    result.ingredient = call.ingredient;
+    result.latency_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - call.start).count();
+
+    if (!ok) {
+        result.success = false;
+        result.vendors_info = {"RPC did not complete"};
+    }
+    else if (!call.status.ok()) {
+        result.success = false;
+        result.vendors_info = {call.status.error_message()};
+    }
+    else {
+        result.success = true;
+        for (const std::string& vendor : call.reply.vendors_info()) {
+            result.vendors_info.push_back(vendor);
+        }
+    }
+    return result;
+}
+
+
+std::string JsonEscape(const std::string& value) {
+    std::ostringstream oss;
+    for (const char c : value) {
+        switch (c) {
+            case '"': oss << "\\\""; break;
+            case '\\': oss << "\\\\"; break;
+            case '\n': oss << "\\n"; break;
+            case '\r': oss << "\\r"; break;
+            case '\t': oss << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    oss << buf;
+                }
+                else {
+                    oss << c;
+                }
+        }
+    }
+    return oss.str();
+}
+
+
+void PrintOrderedResult(const BatchResult& result) {
+    std::cout << result.ingredient << ":" << std::endl;
+
+    if (result.success) {
+        PrintResults(result.vendors_info);
+    }
+    else {
+        std::cout << "ERROR: " << result.vendors_info.at(0) << std::endl;
+    }
+}
+
+
+void PrintJsonResult(const BatchResult& result) {
+    std::ostringstream oss;
+    oss << "{\"index\":" << result.index
+        << ",\"ingredient\":\"" << JsonEscape(result.ingredient) << "\""
+        << ",\"ok\":" << (result.success ? "true" : "false");
+
+    if (result.success) {
+        oss << ",\"vendors_info\":[";
+        for (size_t i = 0; i < result.vendors_info.size(); i++) {
+            if (i > 0) {
+                oss << ",";
+            }
+            oss << "\"" << JsonEscape(result.vendors_info[i]) << "\"";
+        }
+        oss << "]";
+    }
+    else {
+        oss << ",\"error\":\"" << JsonEscape(result.vendors_info.at(0)) << "\"";
+    }
+    oss << ",\"latency_ms\":" << result.latency_ms << "}";
+
+    std::cout << oss.str() << std::endl;
+}
+
+
+void PrintBatchSummary(std::vector<double> latencies, int num_failed, double elapsed_ms) {
+    size_t num_requests = latencies.size();
+
+    std::cerr << std::endl << "Batch summary:" << std::endl;
+    std::cerr << "  requests:   " << num_requests << " (" << num_failed << " failed)" << std::endl;
+    std::cerr << "  elapsed:    " << elapsed_ms << " ms" << std::endl;
+
+    if (num_requests == 0) {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double total_latency = 0;
+    for (double latency : latencies) {
+        total_latency += latency;
+    }
+
+    auto percentile = [&latencies](double p) {
+        size_t rank = static_cast<size_t>(p * (latencies.size() - 1));
+        return latencies[rank];
+    };
+
+    std::cerr << "  throughput: " << num_requests / (elapsed_ms / 1000) << " req/s" << std::endl;
+    std::cerr << "  latency:    mean " << total_latency / num_requests
+              << " ms, p50 " << percentile(0.50)
+              << " ms, p99 " << percentile(0.99)
+              << " ms, max " << latencies.back() << " ms" << std::endl;
+}
+
+
+bool RunBatch(FoodClient& client, std::istream& input, const BatchOptions& options) {
+    CompletionQueue cq;
+
+    // Completed results waiting for earlier ones, when printing in input order
+    std::map<size_t, BatchResult> pending_results;
+    std::vector<double> latencies;
+    int num_failed = 0;
+
+    size_t next_index = 0;
+    size_t next_to_print = 0;
+    int in_flight = 0;
+    bool input_done = false;
+
+    auto batch_start = std::chrono::steady_clock::now();
+
+    while (true) {
+        // Keep the pipeline full
+        while (!input_done && in_flight < options.max_in_flight) {
+            std::string ingredient;
+            if (!ReadIngredient(input, &ingredient)) {
+                input_done = true;
+                break;
+            }
+            client.AsyncGetVendorsInfo(ingredient, next_index++, options.timeout_ms, &cq);
+            in_flight++;
+        }
+
+        if (in_flight == 0) {
+            break;
+        }
+
+        void* tag;
+        bool ok;
+        if (!cq.Next(&tag, &ok)) {
+            break;
+        }
+        std::unique_ptr<AsyncFinderCall> call(static_cast<AsyncFinderCall*>(tag));
+        in_flight--;
+
+        BatchResult result = ToBatchResult(*call, ok);
+        latencies.push_back(result.latency_ms);
+        if (!result.success) {
+            num_failed++;
+        }
+
+        if (options.json) {
+            PrintJsonResult(result);
+            continue;
+        }
+
+        pending_results.emplace(result.index, std::move(result));
+        auto it = pending_results.find(next_to_print);
+        while (it != pending_results.end()) {
+            PrintOrderedResult(it->second);
+            pending_results.erase(it);
+            it = pending_results.find(++next_to_print);
+        }
+    }
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - batch_start).count();
+
+    cq.Shutdown();
+    void* tag;
+    bool ok;
+    while (cq.Next(&tag, &ok)) {}
+
+    PrintBatchSummary(latencies, num_failed, elapsed_ms);
+    return num_failed == 0;
+}
+
+
+bool ParseFlags(int argc, char** argv, BatchOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (arg == "--batch") {
+            options->enabled = true;
+        }
+        else if (arg == "--json") {
+            options->enabled = true;
+            options->json = true;
+        }
+        else if (arg.rfind("--input=", 0) == 0) {
+            options->enabled = true;
+            options->input_file = arg.substr(std::string("--input=").size());
+        }
+        else if (arg.rfind("--max_in_flight=", 0) == 0) {
+            options->enabled = true;
+            if (!ParsePositiveInt(arg.substr(std::string("--max_in_flight=").size()),
+                                  &options->max_in_flight)) {
+                std::cerr << "--max_in_flight must be a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg.rfind("--timeout_ms=", 0) == 0) {
+            options->enabled = true;
+            if (!ParsePositiveInt(arg.substr(std::string("--timeout_ms=").size()),
+                                  &options->timeout_ms)) {
+                std::cerr << "--timeout_ms must be a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else {
+            std::cerr << "Unknown flag: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    // Input piped in rather than typed: no one to prompt
+    if (!isatty(STDIN_FILENO)) {
+        options->enabled = true;
+    }
+    return true;
+}
+
+
 int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!ParseFlags(argc, argv, &options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--batch] [--input=FILE] [--max_in_flight=N] [--timeout_ms=N] [--json]" << std::endl;
+        return 1;
+    }
+
+    FoodClient finder_client(grpc::CreateChannel(
+            kFinderAddress, grpc::InsecureChannelCredentials()));
+
+    if (options.enabled) {
+        if (options.input_file.empty()) {
+            return RunBatch(finder_client, std::cin, options) ? 0 : 1;
+        }
+
+        std::ifstream input(options.input_file);
+        if (!input) {
+            std::cerr << "ERROR: could not open " << options.input_file << std::endl;
+            return 1;
+        }
+        return RunBatch(finder_client, input, options) ? 0 : 1;
+    }
+
     std::cout << std::endl << kUserWelcomeMessage << std::endl;
-    const std::string finder_address = "localhost:50071";
 
     while (true) {
         std::string input_ingredient = GetUserInput();
 
-        FoodClient finder_client(grpc::CreateChannel(
-                finder_address, grpc::InsecureChannelCredentials()));
-
         std::tuple<bool, std::vector<std::string>> finder_return = finder_client.GetVendorsInfo(input_ingredient);
         bool success = std::get<0>(finder_return);
 
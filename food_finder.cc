@@ -23,6 +23,13 @@ opencensus::stats::MeasureDouble RPCLatencyMeasure() {
   return measure;
 }
 
+opencensus::stats::MeasureDouble ViewStalenessMeasure() {
+  static const auto measure =
+      opencensus::stats::MeasureDouble::Register(
+          kViewStalenessMeasureName, "Staleness of the materialized view when queried.", "ms");
+  return measure;
+}
+
 opencensus::tags::TagKey MethodKey() {
   static const opencensus::tags::TagKey key =
       opencensus::tags::TagKey::Register("method");
@@ -44,7 +51,14 @@ std::tuple<bool, std::vector<std::string>> FoodFinder::GetVendors(const std::str
 
     absl::Time start = absl::Now();
 
-    Status status = stub_->GetVendors(&context, request, &reply);
+    Status status;
+    if (service_ != nullptr) {
+        ServerContext server_context;
+        status = ApplyDeadline(service_->GetVendors(&server_context, &request, &reply), start, kServerTimeout);
+    }
+    else {
+        status = stub_->GetVendors(&context, request, &reply);
+    }
 
     // Record latency
     absl::Time end = absl::Now();
@@ -92,7 +106,14 @@ std::tuple<bool, std::string> FoodFinder::GetIngredientInfo(const std::string& i
 
     absl::Time start = absl::Now();
 
-    Status status = stub_->GetIngredientInfo(&context, request, &reply);
+    Status status;
+    if (service_ != nullptr) {
+        ServerContext server_context;
+        status = ApplyDeadline(service_->GetIngredientInfo(&server_context, &request, &reply), start, kServerTimeout);
+    }
+    else {
+        status = stub_->GetIngredientInfo(&context, request, &reply);
+    }
 
     // Record latency
     absl::Time end = absl::Now();
@@ -119,41 +140,341 @@ std::tuple<bool, std::string> FoodFinder::GetIngredientInfo(const std::string& i
 }
 
 
-std::string FoodFinder::FormatIngredientInfo(int inventory_count, float price) {
+// Sync call to FoodSupplier
+bool FoodFinder::SyncVendors(uint64_t known_version, SupplierSyncReply* reply) {
+    SyncRequest request;
+    request.set_known_version(known_version);
+
+    ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() +
+        std::chrono::milliseconds(kSyncTimeout));
+
+    absl::Time start = absl::Now();
+
+    Status status;
+    if (service_ != nullptr) {
+        ServerContext server_context;
+        status = ApplyDeadline(service_->SyncVendors(&server_context, &request, reply), start, kSyncTimeout);
+    }
+    else {
+        status = stub_->SyncVendors(&context, request, reply);
+    }
+
+    if (!status.ok()) {
+        std::cout << "FoodSupplier sync " << status.error_code() << ": "
+                  << status.error_message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// Sync call to FoodVendor
+bool FoodFinder::SyncIngredientInfo(uint64_t known_version, VendorSyncReply* reply) {
+    SyncRequest request;
+    request.set_known_version(known_version);
+
+    ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() +
+        std::chrono::milliseconds(kSyncTimeout));
+
+    absl::Time start = absl::Now();
+
+    Status status;
+    if (service_ != nullptr) {
+        ServerContext server_context;
+        status = ApplyDeadline(service_->SyncIngredientInfo(&server_context, &request, reply), start, kSyncTimeout);
+    }
+    else {
+        status = stub_->SyncIngredientInfo(&context, request, reply);
+    }
+
+    if (!status.ok()) {
+        std::cout << "FoodVendor sync " << status.error_code() << ": "
+                  << status.error_message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+std::string FormatIngredientInfo(int inventory_count, float price) {
     std::ostringstream oss;
     oss << inventory_count << " available @ $" << price;
     return oss.str();
 }
 
 
-Status FoodFinderService::GetVendorsInfo(ServerContext* context, const FinderRequest* request,
-                                         FinderReply* reply){
-    const std::string ingredient = request->ingredient();
+Status FoodFinder::ApplyDeadline(const Status& status, absl::Time start, int timeout_ms) {
+    if (absl::Now() - start > absl::Milliseconds(timeout_ms)) {
+        return Status(StatusCode::DEADLINE_EXCEEDED, "Deadline Exceeded");
+    }
+    return status;
+}
 
-    FoodFinder supplier_finder(grpc::CreateChannel(
-            supplier_address_, grpc::InsecureChannelCredentials()));
 
-    FoodFinder vendor_finder(grpc::CreateChannel(
-            vendor_address_, grpc::InsecureChannelCredentials()));
+ViewFlagResult ParseViewFlag(const std::string& arg, ViewOptions* options) {
+    const std::string sync_interval_flag = "--sync_interval_ms=";
+    const std::string max_staleness_flag = "--max_staleness_ms=";
 
-    static opencensus::trace::AlwaysSampler sampler;
+    if (arg == "--materialized_view") {
+        options->enabled = true;
+        return ViewFlagResult::kParsed;
+    }
 
-    // For metrics
-    grpc::RegisterOpenCensusPlugin();
-    grpc::RegisterOpenCensusViewsForExport();
+    if (arg.rfind(sync_interval_flag, 0) == 0) {
+        if (!ParsePositiveInt(arg.substr(sync_interval_flag.size()), &options->sync_interval_ms)) {
+            std::cerr << "--sync_interval_ms must be a positive integer" << std::endl;
+            return ViewFlagResult::kInvalid;
+        }
+        return ViewFlagResult::kParsed;
+    }
 
-    RegisterExporters();
+    if (arg.rfind(max_staleness_flag, 0) == 0) {
+        if (!ParsePositiveInt(arg.substr(max_staleness_flag.size()), &options->max_staleness_ms)) {
+            std::cerr << "--max_staleness_ms must be a positive integer" << std::endl;
+            return ViewFlagResult::kInvalid;
+        }
+        return ViewFlagResult::kParsed;
+    }
+
+    return ViewFlagResult::kNotViewFlag;
+}
+
+
+FoodFinderView::~FoodFinderView() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+
+    if (sync_thread_.joinable()) {
+        sync_thread_.join();
+    }
+}
+
+
+void FoodFinderView::Start() {
+    if (Sync()) {
+        std::cout << "Materialized view loaded (" << rows_.size() << " ingredients)" << std::endl;
+    }
+    else {
+        std::cout << "Materialized view failed to load, will retry" << std::endl;
+    }
+
+    sync_thread_ = std::thread(&FoodFinderView::SyncLoop, this);
+}
+
+
+ViewLookupResult FoodFinderView::Lookup(const std::string& ingredient,
+                                        std::vector<std::string>* vendors_info,
+                                        absl::Duration* staleness) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (last_sync_ == absl::InfinitePast()) {
+        return ViewLookupResult::kNotLoaded;
+    }
+
+    *staleness = absl::Now() - last_sync_;
+    if (*staleness > absl::Milliseconds(options_.max_staleness_ms)) {
+        return ViewLookupResult::kStale;
+    }
+
+    auto row = rows_.find(ingredient);
+    if (row == rows_.end()) {
+        *vendors_info = {"None"};
+        return ViewLookupResult::kFound;
+    }
+
+    if (!row->second.complete) {
+        return ViewLookupResult::kIncomplete;
+    }
+
+    *vendors_info = row->second.vendors_info;
+    return ViewLookupResult::kFound;
+}
+
+
+// Call on_changed with every key that is added, removed or changed from before to after
+template <typename Map, typename OnChanged>
+void ForEachChangedKey(const Map& before, const Map& after, OnChanged on_changed) {
+    for (const auto& entry : before) {
+        auto match = after.find(entry.first);
+        if (match == after.end() || match->second != entry.second) {
+            on_changed(entry.first);
+        }
+    }
+    for (const auto& entry : after) {
+        if (before.find(entry.first) == before.end()) {
+            on_changed(entry.first);
+        }
+    }
+}
+
+
+bool FoodFinderView::Sync() {
+    SupplierSyncReply supplier_reply;
+    if (!supplier_finder_->SyncVendors(supplier_version_, &supplier_reply)) {
+        return false;
+    }
+
+    VendorSyncReply vendor_reply;
+    if (!vendor_finder_->SyncIngredientInfo(vendor_version_, &vendor_reply)) {
+        return false;
+    }
+
+    std::map<std::string, std::vector<std::string>> new_vendors_by_ingredient;
+    for (const food::SupplierEntry& entry : supplier_reply.entries()) {
+        new_vendors_by_ingredient[entry.ingredient()] = std::vector<std::string>(
+                entry.vendors().begin(), entry.vendors().end());
+    }
+
+    std::map<std::pair<std::string, std::string>, std::pair<int, float>> new_info_by_vendor_ingredient;
+    for (const food::VendorEntry& entry : vendor_reply.entries()) {
+        new_info_by_vendor_ingredient[std::make_pair(entry.vendor_name(), entry.ingredient())] =
+                std::make_pair(entry.inventory_count(), entry.price());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Ingredients whose joined rows need rebuilding
+    std::set<std::string> changed;
+
+    if (!supplier_reply.unchanged()) {
+        ForEachChangedKey(vendors_by_ingredient_, new_vendors_by_ingredient,
+                          [&changed](const std::string& ingredient) {
+                              changed.insert(ingredient);
+                          });
+        vendors_by_ingredient_.swap(new_vendors_by_ingredient);
+    }
+
+    if (!vendor_reply.unchanged()) {
+        ForEachChangedKey(info_by_vendor_ingredient_, new_info_by_vendor_ingredient,
+                          [&changed](const std::pair<std::string, std::string>& vendor_ingredient) {
+                              changed.insert(vendor_ingredient.second);
+                          });
+        info_by_vendor_ingredient_.swap(new_info_by_vendor_ingredient);
+    }
+
+    for (const std::string& ingredient : changed) {
+        RebuildRow(ingredient);
+    }
+
+    supplier_version_ = supplier_reply.version();
+    vendor_version_ = vendor_reply.version();
+    last_sync_ = absl::Now();
+    return true;
+}
+
+
+void FoodFinderView::RebuildRow(const std::string& ingredient) {
+    auto vendors = vendors_by_ingredient_.find(ingredient);
+    if (vendors == vendors_by_ingredient_.end()) {
+        rows_.erase(ingredient);
+        return;
+    }
+
+    Row row = {true, {}};
+
+    for (const std::string& vendor : vendors->second) {
+        auto info = info_by_vendor_ingredient_.find(std::make_pair(vendor, ingredient));
+
+        // FoodVendor does not know this pairing yet; let live lookups report it
+        if (info == info_by_vendor_ingredient_.end()) {
+            row.complete = false;
+            break;
+        }
+
+        std::ostringstream oss;
+        oss << vendor << ": " << FormatIngredientInfo(info->second.first, info->second.second);
+        row.vendors_info.push_back(oss.str());
+    }
+
+    rows_[ingredient] = row;
+}
+
+
+void FoodFinderView::SyncLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stop_cv_.wait_for(lock, std::chrono::milliseconds(options_.sync_interval_ms),
+                              [this] { return stop_; })) {
+        lock.unlock();
+        Sync();
+        lock.lock();
+    }
+}
+
+
+void FoodFinderService::EnableView(const ViewOptions& options) {
+    if (options.max_staleness_ms < options.sync_interval_ms) {
+        std::cerr << "Warning: --max_staleness_ms (" << options.max_staleness_ms
+                  << ") is below --sync_interval_ms (" << options.sync_interval_ms
+                  << "): the view will go stale between syncs" << std::endl;
+    }
+
+    view_.reset(new FoodFinderView(supplier_finder_.get(), vendor_finder_.get(), options));
+    view_->Start();
+}
+
+
+FoodFinderService::FoodFinderService()
+        : FoodFinderService(
+              std::unique_ptr<FoodFinder>(new FoodFinder(grpc::CreateChannel(
+                      kSupplierAddress, grpc::InsecureChannelCredentials()))),
+              std::unique_ptr<FoodFinder>(new FoodFinder(grpc::CreateChannel(
+                      kVendorAddress, grpc::InsecureChannelCredentials())))) {}
+
+
+Status FoodFinderService::GetVendorsInfo(ServerContext* context, const FinderRequest* request,
+                                         FinderReply* reply){
+    const std::string ingredient = request->ingredient();
+
+    static opencensus::trace::AlwaysSampler sampler;
 
     // Begin FoodFinder span
     opencensus::trace::Span finder_span = opencensus::trace::Span::StartSpan(
         "FoodFinder", /* parent = */ nullptr, {&sampler});
     finder_span.AddAnnotation("Requested ingredient: " + ingredient);
 
+    std::vector<std::string> vendors_info;
+    absl::Duration view_staleness;
+    ViewLookupResult view_result = ViewLookupResult::kNotLoaded;
+
+    if (view_ != nullptr) {
+        view_result = view_->Lookup(ingredient, &vendors_info, &view_staleness);
+    }
+
+    if (view_ != nullptr && view_result == ViewLookupResult::kNotLoaded) {
+        finder_span.AddAnnotation("Materialized view not loaded: using live lookup");
+    }
+    else if (view_ != nullptr) {
+        double staleness = absl::ToDoubleMilliseconds(view_staleness);
+        opencensus::stats::Record({{ViewStalenessMeasure(), staleness}});
+
+        if (view_result == ViewLookupResult::kFound) {
+            finder_span.AddAnnotation("Answered from materialized view, " +
+                                      std::to_string(staleness) + " ms stale");
+            for (const std::string& vendor_info : vendors_info) {
+                reply->add_vendors_info(vendor_info);
+            }
+
+            finder_span.End();
+            return Status::OK;
+        }
+
+        const std::string reason = view_result == ViewLookupResult::kStale
+                ? "too stale" : "missing vendor data";
+        finder_span.AddAnnotation("Materialized view " + reason + ", " +
+                                  std::to_string(staleness) + " ms stale: using live lookup");
+    }
+
     // Begin FoodSupplier span
     opencensus::trace::Span supplier_span = opencensus::trace::Span::StartSpan(
         "FoodSupplier", &finder_span, {&sampler});
 
-    std::tuple<bool, std::vector<std::string>> supplier_return = supplier_finder.GetVendors(ingredient);
+    std::tuple<bool, std::vector<std::string>> supplier_return = supplier_finder_->GetVendors(ingredient);
     bool success = std::get<0>(supplier_return);
 
     // FoodSupplier returned an error
@@ -192,7 +513,7 @@ Status FoodFinderService::GetVendorsInfo(ServerContext* context, const FinderReq
         opencensus::trace::Span curr_vendor_span = opencensus::trace::Span::StartSpan(
             span_name, &vendor_span, {&sampler});
 
-        std::tuple<bool, std::string> vendor_return = vendor_finder.GetIngredientInfo(ingredient, vendor);
+        std::tuple<bool, std::string> vendor_return = vendor_finder_->GetIngredientInfo(ingredient, vendor);
         bool success = std::get<0>(vendor_return);
 
         if (!success) {
@@ -220,9 +541,9 @@ Status FoodFinderService::GetVendorsInfo(ServerContext* context, const FinderReq
 }
 
 
-void FoodFinderService::RegisterExporters() {
+void RegisterExporters() {
     // Zipkin
-    opencensus::exporters::trace::ZipkinExporterOptions options = opencensus::exporters::trace::ZipkinExporterOptions(endpoint_);
+    opencensus::exporters::trace::ZipkinExporterOptions options = opencensus::exporters::trace::ZipkinExporterOptions(kZipkinEndpoint);
     options.service_name = "FoodService";
     opencensus::exporters::trace::ZipkinExporter::Register(options);
 
@@ -270,28 +591,73 @@ void RegisterViews() {
               {0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100})))
         .add_column(MethodKey())
         .RegisterForExport();
-}
 
+    ViewStalenessMeasure();
+    opencensus::stats::ViewDescriptor()
+        .set_name("FoodService/ViewStaleness")
+        .set_description("Staleness of the materialized view when queried")
+        .set_measure(kViewStalenessMeasureName)
+        .set_aggregation(opencensus::stats::Aggregation::Distribution(
+          opencensus::stats::BucketBoundaries::Explicit(
+              {0, 500, 1000, 2000, 5000, 10000, 30000, 60000})))
+        .add_column(MethodKey())
+        .RegisterForExport();
+}
 
-void RunFoodFinder() {
-    const std::string server_address = "localhost:50071";
-    FoodFinderService service;
 
+void RegisterTelemetry() {
+    // For metrics
+    grpc::RegisterOpenCensusPlugin();
+    grpc::RegisterOpenCensusViewsForExport();
     RegisterViews();
 
+    RegisterExporters();
+}
+
+
+void ServeFoodFinder(FoodFinderService* service) {
     ServerBuilder builder;
 
-    builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-    builder.RegisterService(&service);
+    builder.AddListeningPort(kFinderAddress, grpc::InsecureServerCredentials());
+    builder.RegisterService(service);
     std::unique_ptr<Server> server(builder.BuildAndStart());
-    std::cout << "Server listening on " << server_address << std::endl;
+    std::cout << "Server listening on " << kFinderAddress << std::endl;
 
     server->Wait();
 }
 
 
+void RunFoodFinder(const ViewOptions& view_options) {
+    RegisterTelemetry();
+
+    FoodFinderService service;
+
+    if (view_options.enabled) {
+        service.EnableView(view_options);
+    }
+
+    ServeFoodFinder(&service);
+}
+
+
+#ifndef FOOD_ALL_IN_ONE
 int main(int argc, char** argv) {
-    RunFoodFinder();
+    ViewOptions view_options;
+
+    for (int i = 1; i < argc; i++) {
+        ViewFlagResult result = ParseViewFlag(argv[i], &view_options);
+
+        if (result != ViewFlagResult::kParsed) {
+            if (result == ViewFlagResult::kNotViewFlag) {
+                std::cerr << "Unknown flag: " << argv[i] << std::endl;
+            }
+            std::cerr << "Usage: " << argv[0] << " " << kViewFlagsUsage << std::endl;
+            return 1;
+        }
+    }
+
+    RunFoodFinder(view_options);
 
     return 0;
 }
+#endif
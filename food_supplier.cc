@@ -1,6 +1,10 @@
 #include "include/food_supplier.h"
 
 
+const std::map<std::string, std::vector<std::string>> * kVendorMap;
+uint64_t kVendorMapVersion = 0;
+
+
 // Called by FoodFinder
 Status FoodSupplierService::GetVendors(ServerContext* context, const SupplierRequest* request,
                     SupplierReply* reply) {
@@ -23,9 +27,34 @@ Status FoodSupplierService::GetVendors(ServerContext* context, const SupplierReq
 }
 
 
-void RunFoodSupplier() {
-    const std::string server_address = "localhost:50051";
+// Called by FoodFinder
+Status FoodSupplierService::SyncVendors(ServerContext* context, const SyncRequest* request,
+                    SupplierSyncReply* reply) {
+    reply->set_version(kVendorMapVersion);
+
+    if (request->known_version() == kVendorMapVersion) {
+        reply->set_unchanged(true);
+        return Status::OK;
+    }
 
+    AddVendorMapEntries(reply);
+    return Status::OK;
+}
+
+
+void AddVendorMapEntries(SupplierSyncReply* reply) {
+    for (const auto& ingredient_vendors : *kVendorMap) {
+        food::SupplierEntry* entry = reply->add_entries();
+        entry->set_ingredient(ingredient_vendors.first);
+
+        for (const std::string& vendor : ingredient_vendors.second) {
+            entry->add_vendors(vendor);
+        }
+    }
+}
+
+
+void LoadVendorMap() {
     kVendorMap = new std::map<std::string, std::vector<std::string>>(
         {
             {"eggs", {"Costco"}},
@@ -34,6 +63,17 @@ void RunFoodSupplier() {
             {"sugar", {"Costco", "Safeway", "Superstore"}}
         });
 
+    SupplierSyncReply snapshot;
+    AddVendorMapEntries(&snapshot);
+    kVendorMapVersion = HashVersion(snapshot.SerializeAsString());
+}
+
+
+void RunFoodSupplier() {
+    const std::string server_address = "localhost:50051";
+
+    LoadVendorMap();
+
     FoodSupplierService service;
     ServerBuilder builder;
 
@@ -48,8 +88,19 @@ void RunFoodSupplier() {
 }
 
 
+#ifndef FOOD_ALL_IN_ONE
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) != "--no_random_faults") {
+            std::cerr << "Unknown flag: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--no_random_faults]" << std::endl;
+            return 1;
+        }
+        SetRandomFaultsEnabled(false);
+    }
+
     RunFoodSupplier();
 
     return 0;
 }
+#endif
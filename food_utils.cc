@@ -1,7 +1,19 @@
 #include "include/food_utils.h"
 
 
+static bool random_faults_enabled = true;
+
+
+void SetRandomFaultsEnabled(bool enabled) {
+    random_faults_enabled = enabled;
+}
+
+
 void CreateRandomDelay(int maxDelay) {
+    if (!random_faults_enabled) {
+        return;
+    }
+
     srand(time(0));
     int delay = rand() % maxDelay;
 
@@ -10,6 +22,10 @@ void CreateRandomDelay(int maxDelay) {
 
 
 bool IsCreateRandomError(int chanceDenom) {
+    if (!random_faults_enabled) {
+        return false;
+    }
+
     srand(time(0));
     int random_number = rand() % chanceDenom;
     if (random_number == 0) {
@@ -17,3 +33,31 @@ bool IsCreateRandomError(int chanceDenom) {
     }
     return false;
 }
+
+
+bool ParsePositiveInt(const std::string& value, int* result) {
+    if (value.empty()) {
+        return false;
+    }
+
+    char* end;
+    errno = 0;
+    long parsed = strtol(value.c_str(), &end, 10);
+
+    if (*end != '\0' || errno == ERANGE || parsed <= 0 || parsed > INT_MAX) {
+        return false;
+    }
+    *result = static_cast<int>(parsed);
+    return true;
+}
+
+
+// 64-bit FNV-1a
+uint64_t HashVersion(const std::string& snapshot) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char c : snapshot) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash == 0 ? 1 : hash;
+}
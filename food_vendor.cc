@@ -1,6 +1,11 @@
 #include "include/food_vendor.h"
 
 
+const std::map<std::string, std::map<std::string, float>> * kInventories;
+const std::map<std::string, std::map<std::string, float>> * kPrices;
+uint64_t kInventoriesVersion = 0;
+
+
 // Called by FoodFinder
 Status FoodVendorService::GetIngredientInfo(ServerContext* context, const VendorRequest* request,
                             VendorReply* reply) {
@@ -25,9 +30,40 @@ Status FoodVendorService::GetIngredientInfo(ServerContext* context, const Vendor
 }
 
 
-void RunFoodVendor() {
-    const std::string server_address = "localhost:50061";
+// Called by FoodFinder
+Status FoodVendorService::SyncIngredientInfo(ServerContext* context, const SyncRequest* request,
+                            VendorSyncReply* reply) {
+    reply->set_version(kInventoriesVersion);
+
+    if (request->known_version() == kInventoriesVersion) {
+        reply->set_unchanged(true);
+        return Status::OK;
+    }
+
+    AddInventoryEntries(reply);
+    return Status::OK;
+}
+
+
+void AddInventoryEntries(VendorSyncReply* reply) {
+    for (const auto& vendor_inventory : *kInventories) {
+        const std::string& vendor = vendor_inventory.first;
+        const std::map<std::string, float>& vendor_prices = kPrices->at(vendor);
+
+        for (const auto& ingredient_inventory : vendor_inventory.second) {
+            const std::string& ingredient = ingredient_inventory.first;
 
+            food::VendorEntry* entry = reply->add_entries();
+            entry->set_vendor_name(vendor);
+            entry->set_ingredient(ingredient);
+            entry->set_inventory_count(ingredient_inventory.second);
+            entry->set_price(vendor_prices.at(ingredient));
+        }
+    }
+}
+
+
+void LoadInventories() {
     kInventories = new std::map<std::string, std::map<std::string, float>>(
         {
             {"Costco", {{"eggs", 10}, {"milk", 45}, {"sugar", 24}}},
@@ -42,6 +78,17 @@ void RunFoodVendor() {
             {"Superstore", {{"flour", 2.00}, {"sugar", 3.35}}}
         });
 
+    VendorSyncReply snapshot;
+    AddInventoryEntries(&snapshot);
+    kInventoriesVersion = HashVersion(snapshot.SerializeAsString());
+}
+
+
+void RunFoodVendor() {
+    const std::string server_address = "localhost:50061";
+
+    LoadInventories();
+
     FoodVendorService service;
     ServerBuilder builder;
 
@@ -58,8 +105,19 @@ void RunFoodVendor() {
 }
 
 
+#ifndef FOOD_ALL_IN_ONE
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) != "--no_random_faults") {
+            std::cerr << "Unknown flag: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--no_random_faults]" << std::endl;
+            return 1;
+        }
+        SetRandomFaultsEnabled(false);
+    }
+
     RunFoodVendor();
 
     return 0;
 }
+#endif
@@ -0,0 +1,22 @@
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <grpcpp/grpcpp.h>
+
+#include "food_finder.h"
+#include "food_supplier.h"
+#include "food_vendor.h"
+
+// How FoodFinder reaches FoodSupplier and FoodVendor within the process
+enum class InternalTransport {
+    kInProcess,  // gRPC in-process channel: no network, still serializes
+    kDirect      // Plain C++ call into the service implementation
+};
+
+// Parse command line flags. Return false on bad usage.
+bool ParseFlags(int argc, char** argv, InternalTransport* transport, ViewOptions* view_options);
+
+// Host FoodSupplier, FoodVendor and FoodFinder in this process.
+// Only FoodFinder listens on the network, on kFinderAddress.
+void RunFoodAllInOne(InternalTransport transport, const ViewOptions& view_options);
@@ -1,13 +1,27 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <tuple>
+#include <vector>
+
+#include <unistd.h>
 
 #include <grpcpp/grpcpp.h>
 
 #include "food.grpc.pb.h"
+#include "food_utils.h"
 
 using grpc::Channel;
+using grpc::ClientAsyncResponseReader;
 using grpc::ClientContext;
+using grpc::CompletionQueue;
 using grpc::Status;
 using food::ExternalFoodService;
 using food::FinderRequest;
@@ -17,17 +31,70 @@ const std::string kGeneralErrorString = "ERROR";
 const std::string kUserWelcomeMessage = "Welcome to FoodFinder!";
 const std::string kUserInputPrompt = "Please input the ingredient you would like to find: ";
 
+const std::string kFinderAddress = "localhost:50071";
+const int kDefaultMaxInFlight = 32;
+const int kDefaultTimeoutMs = 1000;
+
+// State of one outstanding async call to FoodFinder.
+// Its address is used as the completion queue tag.
+struct AsyncFinderCall {
+    size_t index;
+    std::string ingredient;
+    ClientContext context;
+    FinderReply reply;
+    Status status;
+    std::chrono::steady_clock::time_point start;
+    std::unique_ptr<ClientAsyncResponseReader<FinderReply>> response_reader;
+};
+
+// Result of one lookup in batch mode
+struct BatchResult {
+    size_t index;
+    std::string ingredient;
+    bool success;
+    std::vector<std::string> vendors_info;
+    double latency_ms;
+};
+
+// Options for non-interactive batch mode.
+// Setting any of them on the command line turns batch mode on.
+struct BatchOptions {
+    bool enabled = false;
+    std::string input_file;  // Empty means read from stdin
+    int max_in_flight = kDefaultMaxInFlight;
+    int timeout_ms = kDefaultTimeoutMs;
+    bool json = false;
+};
+
 class FoodClient {
  public:
     FoodClient(std::shared_ptr<Channel> channel)
             : stub_(ExternalFoodService::NewStub(channel)) {}
-    
+
     // Call to FoodFinder
     // Return bool to signal success or failure.
     // If success, also return list of vendors with vendor information.
     // If failure, also return error string.
     std::tuple<bool, std::vector<std::string>> GetVendorsInfo(const std::string& ingredient);
 
+    // Async call to FoodFinder
+    // Start the call and return immediately. Once finished, or after
+    // timeout_ms, the call is returned from cq as a tag pointing to an
+    // AsyncFinderCall. Whoever pulls that tag from cq owns the call and must delete it.
+    void AsyncGetVendorsInfo(const std::string& ingredient, size_t index,
+                             int timeout_ms, CompletionQueue* cq);
+
  private:
     std::unique_ptr<ExternalFoodService::Stub> stub_;
 };
+
+
+// Look up every ingredient in input (one per line) over a single channel,
+// keeping up to max_in_flight requests outstanding.
+// Print results in input order, or as JSON lines in completion order,
+// followed by a throughput/latency summary on stderr.
+// Return bool to signal whether every lookup succeeded.
+bool RunBatch(FoodClient& client, std::istream& input, const BatchOptions& options);
+
+// Parse command line flags. Return false on bad usage.
+bool ParseFlags(int argc, char** argv, BatchOptions* options);
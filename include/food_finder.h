@@ -1,13 +1,21 @@
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <tuple>
+#include <utility>
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/opencensus.h>
 
 #include "food.grpc.pb.h"
+#include "food_utils.h"
 
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -33,25 +41,42 @@ using food::VendorRequest;
 using food::VendorReply;
 using food::FinderRequest;
 using food::FinderReply;
+using food::SyncRequest;
+using food::SupplierSyncReply;
+using food::VendorSyncReply;
 
 const std::string kGeneralErrorString = "ERROR";
 const int kServerTimeout = 85;
+const int kSyncTimeout = 1000;
+
+const std::string kSupplierAddress = "localhost:50051";
+const std::string kVendorAddress = "localhost:50061";
+const std::string kFinderAddress = "localhost:50071";
+ABSL_CONST_INIT const absl::string_view kZipkinEndpoint = "http://localhost:9411/api/v2/spans";
 
 // For metrics
 ABSL_CONST_INIT const absl::string_view kRPCErrorMeasureName = "rpc_error_count";
 ABSL_CONST_INIT const absl::string_view kRPCCountMeasureName = "rpc_count";
 ABSL_CONST_INIT const absl::string_view kRPCLatencyMeasureName = "rpc_latency";
+ABSL_CONST_INIT const absl::string_view kViewStalenessMeasureName = "view_staleness";
 
 opencensus::stats::MeasureInt64 RPCErrorCountMeasure();
 opencensus::stats::MeasureInt64 RPCCountMeasure();
 opencensus::stats::MeasureDouble RPCLatencyMeasure();
+opencensus::stats::MeasureDouble ViewStalenessMeasure();
 opencensus::tags::TagKey MethodKey();
 
 
 class FoodFinder {
  public:
+    // Call the service over channel
     FoodFinder(std::shared_ptr<Channel> channel)
-            : stub_(InternalFoodService::NewStub(channel)) {}
+            : stub_(InternalFoodService::NewStub(channel)), service_(nullptr) {}
+
+    // Call service directly in this process, bypassing gRPC.
+    // service is not owned and must outlive this FoodFinder.
+    FoodFinder(InternalFoodService::Service* service)
+            : service_(service) {}
 
     // Call to FoodSupplier
     // Return bool to signal success or failure.
@@ -63,25 +88,145 @@ class FoodFinder {
     // If success, also return ingredient info. If failure, also return error string.
     std::tuple<bool, std::string> GetIngredientInfo(const std::string& ingredient, const std::string& vendorName);
 
+    // Sync calls to FoodSupplier and FoodVendor
+    // Fetch a full snapshot into reply, or only "unchanged" if the service's data
+    // still has known_version. Return bool to signal success or failure.
+    bool SyncVendors(uint64_t known_version, SupplierSyncReply* reply);
+    bool SyncIngredientInfo(uint64_t known_version, VendorSyncReply* reply);
+
  private:
     std::unique_ptr<InternalFoodService::Stub> stub_;
-    std::string FormatIngredientInfo(int inventory_count, float price);
+    InternalFoodService::Service* service_;
+
+    // Direct calls carry no gRPC deadline, so enforce timeout_ms afterwards
+    Status ApplyDeadline(const Status& status, absl::Time start, int timeout_ms);
+};
+
+
+std::string FormatIngredientInfo(int inventory_count, float price);
+
+
+// Options for FoodFinder's materialized view
+struct ViewOptions {
+    bool enabled = false;
+    int sync_interval_ms = 1000;
+    int max_staleness_ms = 5000;
+};
+
+enum class ViewFlagResult {
+    kNotViewFlag,
+    kParsed,
+    kInvalid  // A view flag with a missing, malformed or non-positive value
+};
+
+// Parse a view flag into options
+ViewFlagResult ParseViewFlag(const std::string& arg, ViewOptions* options);
+
+// Usage text for the view flags
+const std::string kViewFlagsUsage = "[--materialized_view] [--sync_interval_ms=N] [--max_staleness_ms=N]";
+
+
+enum class ViewLookupResult {
+    kNotLoaded,   // The view has never synced
+    kStale,       // Last sync is older than max_staleness_ms
+    kIncomplete,  // The view is missing vendor data for the ingredient
+    kFound
+};
+
+
+// Local copy of the ingredient -> vendors -> inventory/price join.
+// Bulk-loaded from FoodSupplier and FoodVendor, then kept fresh by a
+// background thread that reloads a backend's snapshot whenever its data
+// version changes, rebuilding only the rows whose inputs differ.
+class FoodFinderView {
+ public:
+    // supplier_finder and vendor_finder are not owned and must outlive the view
+    FoodFinderView(FoodFinder* supplier_finder, FoodFinder* vendor_finder,
+                   const ViewOptions& options)
+            : supplier_finder_(supplier_finder), vendor_finder_(vendor_finder),
+              options_(options) {}
+
+    ~FoodFinderView();
+
+    // Bulk load, then start periodic syncs
+    void Start();
+
+    // Look up ingredient in the view.
+    // Unless kNotLoaded, also return the staleness the lookup was judged by.
+    // If kFound, also fill vendors_info as FoodFinderService would.
+    ViewLookupResult Lookup(const std::string& ingredient, std::vector<std::string>* vendors_info,
+                            absl::Duration* staleness);
+
+ private:
+    struct Row {
+        bool complete;
+        std::vector<std::string> vendors_info;
+    };
+
+    FoodFinder* supplier_finder_;
+    FoodFinder* vendor_finder_;
+    const ViewOptions options_;
+
+    // Only touched by the sync thread (or by Start() before it runs)
+    uint64_t supplier_version_ = 0;
+    uint64_t vendor_version_ = 0;
+
+    std::mutex mutex_;
+    std::map<std::string, std::vector<std::string>> vendors_by_ingredient_;
+    std::map<std::pair<std::string, std::string>, std::pair<int, float>> info_by_vendor_ingredient_;
+    std::map<std::string, Row> rows_;
+    absl::Time last_sync_ = absl::InfinitePast();
+
+    std::thread sync_thread_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+
+    // Fetch and apply one round of snapshots. Return bool to signal success or failure.
+    bool Sync();
+
+    // Recompute the joined row for ingredient. Requires mutex_.
+    void RebuildRow(const std::string& ingredient);
+
+    void SyncLoop();
 };
 
 
 class FoodFinderService final : public ExternalFoodService::Service {
-    const std::string supplier_address_ = "localhost:50051";
-    const std::string vendor_address_ = "localhost:50061";
-    const absl::string_view endpoint_ = "http://localhost:9411/api/v2/spans";
+ public:
+    // Reach FoodSupplier and FoodVendor over TCP at their default addresses
+    FoodFinderService();
 
-    Status GetVendorsInfo(ServerContext* context, const FinderRequest* request,
-                          FinderReply* reply) override;
+    // Reach FoodSupplier and FoodVendor through the given FoodFinders
+    FoodFinderService(std::unique_ptr<FoodFinder> supplier_finder,
+                      std::unique_ptr<FoodFinder> vendor_finder)
+            : supplier_finder_(std::move(supplier_finder)),
+              vendor_finder_(std::move(vendor_finder)) {}
+
+    // Answer from a materialized view while it is fresh enough
+    void EnableView(const ViewOptions& options);
 
  private:
-    void RegisterExporters();
+    std::unique_ptr<FoodFinder> supplier_finder_;
+    std::unique_ptr<FoodFinder> vendor_finder_;
+
+    // Declared after the finders it uses, so it is destroyed first
+    std::unique_ptr<FoodFinderView> view_;
+
+    Status GetVendorsInfo(ServerContext* context, const FinderRequest* request,
+                          FinderReply* reply) override;
 };
 
 
 void RegisterViews();
 
-void RunFoodFinder();
+void RegisterExporters();
+
+// Register the gRPC OpenCensus plugin, views and exporters.
+// Call once, before any channel or server is created: gRPC only
+// instruments channels and servers built after the plugin is registered.
+void RegisterTelemetry();
+
+// Serve service on kFinderAddress until shutdown
+void ServeFoodFinder(FoodFinderService* service);
+
+void RunFoodFinder(const ViewOptions& view_options);
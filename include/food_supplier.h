@@ -16,17 +16,33 @@ using grpc::StatusCode;
 using food::InternalFoodService;
 using food::SupplierRequest;
 using food::SupplierReply;
+using food::SyncRequest;
+using food::SupplierSyncReply;
 
-const std::map<std::string, std::vector<std::string>> * kVendorMap;
+extern const std::map<std::string, std::vector<std::string>> * kVendorMap;
+
+// Hash of kVendorMap's contents, set by LoadVendorMap()
+extern uint64_t kVendorMapVersion;
 
 class FoodSupplierService final : public InternalFoodService::Service {
+ public:
     // Called by FoodFinder
     Status GetVendors(ServerContext* context, const SupplierRequest* request,
                       SupplierReply* reply) override;
 
+    // Called by FoodFinder to load or refresh its materialized view
+    Status SyncVendors(ServerContext* context, const SyncRequest* request,
+                       SupplierSyncReply* reply) override;
+
  private:
     const int kMaxRandomDelay_ = 100;
     const int kRandomErrorChanceDenom_ = 8;
 };
 
+// Add one entry per ingredient in kVendorMap to reply
+void AddVendorMapEntries(SupplierSyncReply* reply);
+
+// Populate kVendorMap and kVendorMapVersion
+void LoadVendorMap();
+
 void RunFoodSupplier();
@@ -1,11 +1,27 @@
+#include <cerrno>
 #include <chrono>
+#include <climits>
+#include <cstdint>
+#include <string>
 #include <thread>
 #include <ctime>
 #include <cstdlib>
 
 
+// Turn the random delays and errors below on or off (on by default).
+// When off, CreateRandomDelay never sleeps and IsCreateRandomError is always false.
+void SetRandomFaultsEnabled(bool enabled);
+
 // Create delay between 0 and maxDelay milliseconds
 void CreateRandomDelay(int maxDelay);
 
 // Decide whether to throw an error, with 1/chanceDenom chance
 bool IsCreateRandomError(int chanceDenom);
+
+// Derive a data version from a serialized snapshot of the data.
+// Equal snapshots give equal versions; the result is never 0.
+uint64_t HashVersion(const std::string& snapshot);
+
+// Parse value as a positive int, rejecting trailing characters and overflow.
+// Return false if value is anything else.
+bool ParsePositiveInt(const std::string& value, int* result);
@@ -16,18 +16,34 @@ using grpc::StatusCode;
 using food::InternalFoodService;
 using food::VendorRequest;
 using food::VendorReply;
+using food::SyncRequest;
+using food::VendorSyncReply;
 
-const std::map<std::string, std::map<std::string, float>> * kInventories;
-const std::map<std::string, std::map<std::string, float>> * kPrices;
+extern const std::map<std::string, std::map<std::string, float>> * kInventories;
+extern const std::map<std::string, std::map<std::string, float>> * kPrices;
+
+// Hash of kInventories' and kPrices' contents, set by LoadInventories()
+extern uint64_t kInventoriesVersion;
 
 class FoodVendorService final : public InternalFoodService::Service {
+ public:
     // Called by FoodFinder
     Status GetIngredientInfo(ServerContext* context, const VendorRequest* request,
                              VendorReply* reply) override;
 
+    // Called by FoodFinder to load or refresh its materialized view
+    Status SyncIngredientInfo(ServerContext* context, const SyncRequest* request,
+                              VendorSyncReply* reply) override;
+
  private:
     const int kMaxRandomDelay_ = 100;
     const int kRandomErrorChanceDenom_ = 8;
 };
 
+// Add one entry per vendor and ingredient in kInventories to reply
+void AddInventoryEntries(VendorSyncReply* reply);
+
+// Populate kInventories, kPrices and kInventoriesVersion
+void LoadInventories();
+
 void RunFoodVendor();